@@ -0,0 +1,71 @@
+#ifndef MSG_FRAME_HPP
+#define MSG_FRAME_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <winsock2.h>
+
+#include "../Utils/Crc32c.hpp"
+
+// 消息帧格式：| 4字节消息体长度（大端序） | 4字节流ID（大端序） | 消息体 | 4字节校验和（大端序，可选） |
+// 流ID 用于在同一条连接上区分多路逻辑流，并关联请求与响应；流ID 为 0 表示普通消息（不需要关联）
+// 校验和是消息头和消息体的 CRC32C，只有连接双方在握手时都启用了 MSG_FRAME_FEATURE_CRC32C 才会发送
+#define MSG_FRAME_HEADER_SIZE 8
+#define MSG_FRAME_TRAILER_SIZE 4
+#define MSG_FRAME_DEFAULT_STREAM_ID 0
+#define MSG_FRAME_MAX_BODY_LENGTH (64 * 1024 * 1024)
+
+// 握手时交换的特性标志（4字节，大端序），连接启用双方都支持的特性
+#define MSG_FRAME_HANDSHAKE_SIZE 4
+#define MSG_FRAME_HANDSHAKE_TIMEOUT_MS 5000
+#define MSG_FRAME_FEATURE_NONE 0u
+#define MSG_FRAME_FEATURE_CRC32C 1u
+
+// 构造消息头，写入 dst 指向的 MSG_FRAME_HEADER_SIZE 个字节
+inline void encodeMsgFrameHeader(char* dst, const uint32_t msgBodyLength, const uint32_t streamId) {
+    const uint32_t msgBodyLengthBE = htonl(msgBodyLength); // 转换为大端序
+    const uint32_t streamIdBE = htonl(streamId);
+    std::memcpy(dst, &msgBodyLengthBE, 4);
+    std::memcpy(dst + 4, &streamIdBE, 4);
+}
+
+// 解析消息头，src 指向 MSG_FRAME_HEADER_SIZE 个字节（用 memcpy 读取，避免字节对齐问题）
+inline void decodeMsgFrameHeader(const char* src, uint32_t& msgBodyLength, uint32_t& streamId) {
+    std::memcpy(&msgBodyLength, src, 4);
+    std::memcpy(&streamId, src + 4, 4);
+    msgBodyLength = ntohl(msgBodyLength);
+    streamId = ntohl(streamId);
+}
+
+// 编码完成的消息帧（消息头 + 消息体 + 校验和），只读且引用计数，可以被多个连接的发送队列共享而不复制
+// 总是为校验和预留位置，未启用校验的连接发送时省略最后 MSG_FRAME_TRAILER_SIZE 个字节；
+// 启用校验的连接只能发送编码时计算了校验和的消息帧
+using SharedMsgFrame = std::shared_ptr<const std::vector<char>>;
+
+// 将消息编码为消息帧，只分配和复制一次；withChecksum 为 true 时在复制消息体的同时计算校验和，
+// 否则只复制消息体，校验和位置填 0
+inline SharedMsgFrame makeSharedMsgFrame(const char* msg, const bool withChecksum,
+                                         const uint32_t streamId = MSG_FRAME_DEFAULT_STREAM_ID) {
+    const size_t msgLength = std::strlen(msg);
+    if (msgLength > MSG_FRAME_MAX_BODY_LENGTH) {
+        throw std::length_error("Message too long: " + std::to_string(msgLength));
+    }
+    const auto msgFrame = std::make_shared<std::vector<char>>(MSG_FRAME_HEADER_SIZE + msgLength + MSG_FRAME_TRAILER_SIZE);
+    char* const data = msgFrame->data();
+    encodeMsgFrameHeader(data, static_cast<uint32_t>(msgLength), streamId);
+    if (!withChecksum) {
+        std::memcpy(data + MSG_FRAME_HEADER_SIZE, msg, msgLength);
+        return msgFrame;
+    }
+    uint32_t checksum = crc32c(0, data, MSG_FRAME_HEADER_SIZE);
+    checksum = crc32cCopy(checksum, data + MSG_FRAME_HEADER_SIZE, msg, msgLength);
+    const uint32_t checksumBE = htonl(checksum);
+    std::memcpy(data + MSG_FRAME_HEADER_SIZE + msgLength, &checksumBE, MSG_FRAME_TRAILER_SIZE);
+    return msgFrame;
+}
+
+#endif // MSG_FRAME_HPP
@@ -0,0 +1,173 @@
+#ifndef NIO_TCP_MSG_BROADCASTER_HPP
+#define NIO_TCP_MSG_BROADCASTER_HPP
+
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include "MsgFrame.hpp"
+#include "NioTcpMsgSenderReceiver.hpp"
+
+// 订阅者发送队列已满时的处理策略
+enum class SlowSubscriberPolicy {
+    DropMsg,        // 该订阅者跳过这条消息（落后），其他订阅者不受影响
+    DropSubscriber  // 取消该订阅者的所有订阅
+};
+
+// 按主题广播消息：每条消息只编码一次，所有订阅者的发送队列共享同一个消息帧，
+// 发布者从不因为某个订阅者发送慢而阻塞；连接已关闭的订阅者在发布时被自动移除
+class NioTcpMsgBroadcaster {
+public:
+    // 订阅者因为发送慢（DropSubscriber 策略）被取消订阅时的回调，参数为被取消的主题，在发布线程中调用
+    using SubscriberDroppedCallback = std::function<void(const std::string& topic)>;
+
+    // 订阅主题；订阅者在销毁前必须调用 unsubscribeAll
+    void subscribe(const std::string& topic, NioTcpMsgSenderReceiver* subscriber,
+                   const SlowSubscriberPolicy policy = SlowSubscriberPolicy::DropMsg,
+                   SubscriberDroppedCallback onDropped = nullptr) {
+        std::lock_guard<std::mutex> lock(topicsMutex);
+        std::vector<Subscription>& subscriptions = topics[topic];
+        for (const auto& subscription : subscriptions) {
+            if (subscription.subscriber == subscriber) return; // 已经订阅过
+        }
+        subscriptions.push_back(Subscription{topic, subscriber, policy, 0, std::move(onDropped)});
+    }
+
+    // 取消订阅主题
+    void unsubscribe(const std::string& topic, NioTcpMsgSenderReceiver* subscriber) {
+        std::lock_guard<std::mutex> lock(topicsMutex);
+        const auto it = topics.find(topic);
+        if (it == topics.end()) return;
+        removeSubscriber(it->second, subscriber);
+        if (it->second.empty()) topics.erase(it);
+    }
+
+    // 取消订阅者的所有订阅
+    void unsubscribeAll(NioTcpMsgSenderReceiver* subscriber) {
+        std::lock_guard<std::mutex> lock(topicsMutex);
+        removeSubscriberFromAllTopics(subscriber);
+    }
+
+    // 向主题发布消息，返回成功放入发送队列的订阅者数
+    size_t publish(const std::string& topic, const char* msg) {
+        std::vector<NioTcpMsgSenderReceiver*> closedSubscribers;
+        std::vector<NioTcpMsgSenderReceiver*> slowSubscribers;
+        std::vector<Subscription> droppedSubscriptions;
+        size_t delivered = 0;
+        {
+            std::lock_guard<std::mutex> lock(topicsMutex);
+            const auto it = topics.find(topic);
+            if (it == topics.end()) return 0;
+
+            // 只编码一次；只有存在启用校验的订阅者时才计算校验和，其他订阅者只需要复制消息体
+            bool withChecksum = false;
+            for (const auto& subscription : it->second) {
+                if (subscription.subscriber->isCrc32cEnabled()) {
+                    withChecksum = true;
+                    break;
+                }
+            }
+            const SharedMsgFrame msgFrame = makeSharedMsgFrame(msg, withChecksum);
+
+            for (auto& subscription : it->second) {
+                // 连接已关闭的订阅者不再投递，稍后移除
+                if (subscription.subscriber->isClosed()) {
+                    closedSubscribers.push_back(subscription.subscriber);
+                    continue;
+                }
+                // 非阻塞入队，只增加引用计数，不复制消息
+                if (subscription.subscriber->trySendMsgFrame(msgFrame)) {
+                    ++delivered;
+                    continue;
+                }
+                ++subscription.droppedMsgCount;
+                if (subscription.policy == SlowSubscriberPolicy::DropSubscriber) {
+                    slowSubscribers.push_back(subscription.subscriber);
+                }
+            }
+
+            for (const auto closedSubscriber : closedSubscribers) {
+                removeSubscriberFromAllTopics(closedSubscriber);
+            }
+            for (const auto slowSubscriber : slowSubscribers) {
+                std::vector<Subscription> removed = removeSubscriberFromAllTopics(slowSubscriber);
+                droppedSubscriptions.insert(droppedSubscriptions.end(), removed.begin(), removed.end());
+            }
+        }
+
+        // 在锁外通知被取消订阅的订阅者，允许回调中重新订阅
+        for (const auto slowSubscriber : slowSubscribers) {
+            std::cerr << "Subscriber " << slowSubscriber << " is too slow, unsubscribed from all topics." << std::endl;
+        }
+        for (const auto& droppedSubscription : droppedSubscriptions) {
+            if (droppedSubscription.onDropped) droppedSubscription.onDropped(droppedSubscription.topic);
+        }
+        return delivered;
+    }
+
+    // 订阅者在主题上因发送队列满而跳过的消息数
+    size_t droppedMsgCount(const std::string& topic, NioTcpMsgSenderReceiver* subscriber) const {
+        std::lock_guard<std::mutex> lock(topicsMutex);
+        const auto it = topics.find(topic);
+        if (it == topics.end()) return 0;
+        for (const auto& subscription : it->second) {
+            if (subscription.subscriber == subscriber) return subscription.droppedMsgCount;
+        }
+        return 0;
+    }
+
+    // 主题的订阅者数
+    size_t subscriberCount(const std::string& topic) const {
+        std::lock_guard<std::mutex> lock(topicsMutex);
+        const auto it = topics.find(topic);
+        return it == topics.end() ? 0 : it->second.size();
+    }
+
+private:
+    struct Subscription {
+        std::string topic;
+        NioTcpMsgSenderReceiver* subscriber;
+        SlowSubscriberPolicy policy;
+        size_t droppedMsgCount;
+        SubscriberDroppedCallback onDropped;
+    };
+
+    // 主题 -> 订阅列表
+    std::unordered_map<std::string, std::vector<Subscription>> topics;
+    mutable std::mutex topicsMutex;
+
+    // 移除订阅者，返回被移除的订阅
+    static std::vector<Subscription> removeSubscriber(std::vector<Subscription>& subscriptions,
+                                                      NioTcpMsgSenderReceiver* subscriber) {
+        std::vector<Subscription> removed;
+        for (auto it = subscriptions.begin(); it != subscriptions.end();) {
+            if (it->subscriber == subscriber) {
+                removed.push_back(std::move(*it));
+                it = subscriptions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return removed;
+    }
+
+    // 从所有主题中移除订阅者，返回被移除的订阅；调用方需持有 topicsMutex
+    std::vector<Subscription> removeSubscriberFromAllTopics(NioTcpMsgSenderReceiver* subscriber) {
+        std::vector<Subscription> removed;
+        for (auto it = topics.begin(); it != topics.end();) {
+            std::vector<Subscription> removedFromTopic = removeSubscriber(it->second, subscriber);
+            removed.insert(removed.end(), removedFromTopic.begin(), removedFromTopic.end());
+            if (it->second.empty()) {
+                it = topics.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return removed;
+    }
+};
+
+#endif // NIO_TCP_MSG_BROADCASTER_HPP
@@ -5,22 +5,56 @@
 #include <thread>
 #include <atomic>
 #include <cstring>
+#include <string>
 #include <winsock2.h>
 
+#include "MsgFrame.hpp"
 #include "../Utils/ThreadSafeQueue.hpp"
+#include "../Utils/ThreadPlacement.hpp"
+#include "../Utils/NumaBuffer.hpp"
 
 #define BUFFER_SIZE 1024
 #define MSG_QUEUE_MAXSIZE 4096
 
+// 队列元素：消息所属的流ID + 消息内容
+struct StreamMsg {
+    uint32_t streamId;
+    const char* msg;
+};
+
 class NioTcpMsgSenderReceiver {
 public:
-    explicit NioTcpMsgSenderReceiver(const SOCKET s) {
+    // 构造时与对端握手，握手失败（对端关闭、出错或超时）时抛出 runtime_error，此时套接字仍由调用方关闭；
+    // 构造成功后套接字归本对象所有，连接关闭后由本对象关闭
+    // placement 指定发送线程和接收线程的放置位置（两者放在同一组CPU上），接收缓冲区从其 NUMA 节点分配
+    // features 为本端希望启用的特性（MSG_FRAME_FEATURE_*），与对端握手后只启用双方都支持的特性
+    explicit NioTcpMsgSenderReceiver(const SOCKET s, const ThreadPlacement& placement = ThreadPlacement(),
+                                     const uint32_t features = MSG_FRAME_FEATURE_NONE)
+        : placement(placement), recvBuffer(placement.numaNode, MSG_FRAME_MAX_BODY_LENGTH + MSG_FRAME_TRAILER_SIZE) {
         if (s == INVALID_SOCKET) {
             throw std::runtime_error("NIOSocketSenderReceiver initialization failed: invalid socket.");
         }
         this->socket = s;
 
+        // 握手：交换特性标志；握手期间设置接收超时，避免对端不发送特性标志时一直阻塞
+        if (!setRecvTimeout(MSG_FRAME_HANDSHAKE_TIMEOUT_MS)) {
+            throw std::runtime_error("NIOSocketSenderReceiver initialization failed: setsockopt error: " +
+                                     std::to_string(WSAGetLastError()));
+        }
+        const uint32_t featuresBE = htonl(features);
+        char peerFeaturesBE[MSG_FRAME_HANDSHAKE_SIZE]{};
+        if (!sendAll(reinterpret_cast<const char*>(&featuresBE), MSG_FRAME_HANDSHAKE_SIZE) ||
+            !recvAll(peerFeaturesBE, MSG_FRAME_HANDSHAKE_SIZE) ||
+            !setRecvTimeout(0)) {
+            throw std::runtime_error("NIOSocketSenderReceiver initialization failed: handshake failed.");
+        }
+        uint32_t peerFeatures = MSG_FRAME_FEATURE_NONE;
+        std::memcpy(&peerFeatures, peerFeaturesBE, MSG_FRAME_HANDSHAKE_SIZE);
+        peerFeatures = ntohl(peerFeatures);
+        crc32cEnabled = (features & peerFeatures & MSG_FRAME_FEATURE_CRC32C) != 0;
+
         // 启动发送线程
+        runningWorkers.store(2);
         sendThreadRunFlag.store(true);
         sendThread = std::thread(&NioTcpMsgSenderReceiver::sendMsgWorker, this);
 
@@ -30,45 +64,50 @@ public:
     }
 
     ~NioTcpMsgSenderReceiver() {
-        // 在析构函数中停止所有线程
+        // 在析构函数中停止所有线程：关闭套接字和队列，唤醒阻塞在 recv 和队列上的线程
         sendThreadRunFlag.store(false);
         recvThreadRunFlag.store(false);
+        closeConnection(false);
         if (sendThread.joinable()) sendThread.join();
         if (recvThread.joinable()) recvThread.join();
 
-        // 在析构函数中释放所有队列元素的内存
-        while (!sendMsgQueue.empty()) {
-            const char* str = sendMsgQueue.dequeue();
-            delete[] str;
-        }
-        while (!recvMsgQueue.empty()) {
-            const char* str = recvMsgQueue.dequeue();
-            delete[] str;
+        // 在析构函数中释放所有队列元素的内存（发送队列中的消息帧由引用计数自动释放）
+        StreamMsg item{};
+        while (recvMsgQueue.tryDequeue(item)) {
+            delete[] item.msg;
         }
     }
 
-    // 将消息放入发送消息队列（生产者）
-    void sendMsg(const char* msg) {
-        // 分配内存
-        const auto newMsg = static_cast<char*>(std::malloc(std::strlen(msg)));
-        if (newMsg) {
-            // 将内存的内容设置为 '\0'
-            std::memset(newMsg, '\0', std::strlen(msg));
-            // 复制字符串
-            std::strcpy(newMsg, msg);
-            // 添加到队列
-            sendMsgQueue.enqueue(newMsg);
-        } else {
-            throw std::runtime_error("Malloc memory faild.");
-        }
+    // 将消息放入发送消息队列（生产者），streamId 指定消息所属的逻辑流；连接已关闭时返回 false
+    bool sendMsg(const char* msg, const uint32_t streamId = MSG_FRAME_DEFAULT_STREAM_ID) {
+        // 编码为消息帧（只在启用校验时计算校验和），并添加到队列
+        return sendMsgQueue.enqueue(makeSharedMsgFrame(msg, crc32cEnabled, streamId));
     }
 
-    // 取出接收消息队列的消息（消费者）
+    // 将已编码的消息帧放入发送消息队列（生产者），队列满时阻塞；连接已关闭时返回 false
+    // 启用校验的连接（isCrc32cEnabled）需要带校验和的消息帧
+    bool sendMsgFrame(const SharedMsgFrame& msgFrame) {
+        return sendMsgQueue.enqueue(msgFrame);
+    }
+
+    // 尝试将已编码的消息帧放入发送消息队列，非阻塞，队列满或连接已关闭时返回 false
+    bool trySendMsgFrame(const SharedMsgFrame& msgFrame) {
+        return sendMsgQueue.tryEnqueue(msgFrame);
+    }
+
+    // 取出接收消息队列的消息（消费者）；连接已关闭且消息都已取出时返回 nullptr
     const char* recvMsg() {
-        // 退队列头元素（如果队列为空，则阻塞，直到队列不为空）
-        const char* msg = recvMsgQueue.dequeue();
+        uint32_t streamId = MSG_FRAME_DEFAULT_STREAM_ID;
+        return recvMsg(streamId);
+    }
+
+    // 取出接收消息队列的消息（消费者），并通过 streamId 返回消息所属的逻辑流；连接已关闭且消息都已取出时返回 nullptr
+    const char* recvMsg(uint32_t& streamId) {
+        // 退队列头元素（如果队列为空，则阻塞，直到队列不为空或连接关闭）
+        const StreamMsg item = recvMsgQueue.dequeue();
+        streamId = item.streamId;
         // 返回
-        return msg;
+        return item.msg;
     }
 
     // 发送消息队列长度
@@ -81,113 +120,210 @@ public:
         return recvMsgQueue.size();
     }
 
+    // 主动关闭连接，唤醒阻塞在 recvMsg 和 sendMsg 中的线程
+    void close() {
+        closeConnection(false);
+    }
+
+    // 连接是否已关闭（主动关闭、对端关闭、收发出错或校验失败）
+    bool isClosed() const {
+        return closed;
+    }
+
+    // 握手后是否启用了 CRC32C 校验
+    bool isCrc32cEnabled() const {
+        return crc32cEnabled;
+    }
+
+    // 发送线程和接收线程的放置位置，消费者线程可以用它与本连接放在一起
+    const ThreadPlacement& threadPlacement() const {
+        return placement;
+    }
+
 private:
     // 目标套接字
     SOCKET socket = INVALID_SOCKET;
 
+    // 线程放置配置
+    ThreadPlacement placement;
+
+    // 是否在消息帧后附加并校验 CRC32C（握手时确定，之后不再改变）
+    bool crc32cEnabled{false};
+
+    // 连接是否已关闭
+    std::atomic<bool> closed{false};
+
+    // 仍在运行的收发线程数，最后退出的线程关闭套接字
+    std::atomic<int> runningWorkers{0};
+
+    // 接收缓冲区（从 placement 指定的 NUMA 节点分配，只在接收线程中使用，第一次收到消息时才分配）
+    NumaBuffer recvBuffer;
+
     // 消息发送线程
     std::thread sendThread;
     std::atomic<bool> sendThreadRunFlag{false};
 
     // 消息发送队列
-    ThreadSafeQueue<const char*> sendMsgQueue{MSG_QUEUE_MAXSIZE};
+    ThreadSafeQueue<SharedMsgFrame> sendMsgQueue{MSG_QUEUE_MAXSIZE};
 
     // 消息接收线程
     std::thread recvThread;
     std::atomic<bool> recvThreadRunFlag{false};
 
     // 消息接收队列
-    ThreadSafeQueue<const char*> recvMsgQueue{MSG_QUEUE_MAXSIZE};
+    ThreadSafeQueue<StreamMsg> recvMsgQueue{MSG_QUEUE_MAXSIZE};
 
     // 取出发送消息队列的消息（消费者），并写入到套接字发送缓冲区
     void sendMsgWorker() {
+        placement.applyToCurrentThread();
         while (sendThreadRunFlag) {
             // 退队列头元素（如果队列为空，则阻塞，直到队列不为空）
-            const char* const msg = sendMsgQueue.dequeue();
-
-            // 1、创建消息帧
-            const size_t msgFrameLength = 4 + strlen(msg);
-            char msgFrame[msgFrameLength]{};
-            // 2、构造消息头
-            const size_t msgLength = strlen(msg);
-            auto msgLengthBE = htonl(msgLength); // 转换为大端序
-            // 3、将消息头复制到消息帧前4个字节
-            std::memcpy(msgFrame, &msgLengthBE, 4);
-            // 4、将消息复制到消息帧，从第5个字节开始
-            std::memcpy(msgFrame + 4, msg, strlen(msg));
-
-            // 清理
-            delete[] msg;
+            // 消息帧在入队前已编码完成，这里直接发送，不再复制
+            const SharedMsgFrame msgFrame = sendMsgQueue.dequeue();
+            if (!msgFrame) break; // 连接已关闭
+            if (closed) break;    // 连接已关闭（例如被重置），丢弃队列中剩余的消息
+            // 未启用校验时省略校验和
+            const size_t msgFrameLength = msgFrame->size() - (crc32cEnabled ? 0 : MSG_FRAME_TRAILER_SIZE);
 
             // 将待发送的信息写入到套接字的发送缓冲区中
-            size_t sent = 0;
-            while (sent < msgFrameLength) {
-                const int result = send(socket, msgFrame, static_cast<int>(msgFrameLength - sent), 0);
-                if (result == SOCKET_ERROR) {
-                    std::cerr << "Send failed with error: " << WSAGetLastError() << std::endl;
-                    return;
-                }
-                sent += result;
+            if (!sendAll(msgFrame->data(), msgFrameLength)) {
+                closeConnection(false);
+                break;
             }
         }
+        onWorkerExit();
     }
 
     // 取出套接字缓冲区的内容，放入接收消息队列（生产者）
     void recvMsgWorker() {
+        placement.applyToCurrentThread();
         // 从套接字的接收缓冲区中获取信息
         while (recvThreadRunFlag) {
             // 1、读数据头
-            char msgHeaderBE[4]{};
-            int totalReceived = 0;
-            while (totalReceived < 4) {
-                const int bytesReceived = recv(socket, msgHeaderBE + totalReceived, 4 - totalReceived, 0);
-                if (bytesReceived == SOCKET_ERROR) {
-                    std::cerr << "Recv failed with error: " << WSAGetLastError() << std::endl;
-                    return;
-                }
-                if (bytesReceived == 0) {
-                    std::cerr << "Connection closed by the peer." << std::endl;
-                    return;
-                }
-                totalReceived += bytesReceived;
+            char msgHeaderBE[MSG_FRAME_HEADER_SIZE]{};
+            if (!recvAll(msgHeaderBE, MSG_FRAME_HEADER_SIZE)) break;
+
+            // 2、解析消息头（消息体长度 + 流ID），转换为小端序
+            uint32_t msgBodyLength = 0;
+            uint32_t streamId = MSG_FRAME_DEFAULT_STREAM_ID;
+            decodeMsgFrameHeader(msgHeaderBE, msgBodyLength, streamId);
+
+            // 消息头损坏时长度不可信，不能按它分配内存，也无法再找到下一帧的边界
+            if (msgBodyLength > MSG_FRAME_MAX_BODY_LENGTH) {
+                resetConnection("Invalid message length: " + std::to_string(msgBodyLength));
+                break;
             }
 
-            // 2、转换为小端序
-            // const unsigned int msgBodyLength = ntohl(*reinterpret_cast<const unsigned int*>(msgHeaderBE)); // 这样做可能会导致字节对齐问题
-            unsigned int msgBodyLength = 0;
-            std::memcpy(&msgBodyLength, msgHeaderBE, 4);
-            msgBodyLength = ntohl(msgBodyLength);
-
-
-            // 3、根据消息体长度读消息体
-            char msgBody[msgBodyLength + 1]{};
-            totalReceived = 0;
-            while (totalReceived < msgBodyLength) {
-                const int bytesReceived = recv(socket, msgBody + totalReceived,
-                                               static_cast<int>(msgBodyLength) - totalReceived, 0);
-                if (bytesReceived == SOCKET_ERROR) {
-                    std::cerr << "Recv failed with error: " << WSAGetLastError() << std::endl;
-                    return;
-                }
-                if (bytesReceived == 0) {
-                    std::cerr << "Connection closed by the peer." << std::endl;
-                    return;
-                }
-                totalReceived += bytesReceived;
+            // 3、根据消息体长度读消息体（以及校验和）到接收缓冲区
+            const size_t trailerLength = crc32cEnabled ? MSG_FRAME_TRAILER_SIZE : 0;
+            try {
+                recvBuffer.reserve(msgBodyLength + trailerLength);
+            } catch (const std::exception& e) {
+                resetConnection(e.what());
+                break;
             }
+            char* const msgBody = recvBuffer.data();
+            if (!recvAll(msgBody, msgBodyLength + trailerLength)) break;
 
-            // 分配内存
-            const auto recvMsg = static_cast<char*>(std::malloc(msgBodyLength));
-            if (recvMsg) {
-                // 将内存的内容设置为 '\0'
-                std::memset(recvMsg, '\0', msgBodyLength);
-                // 复制字符串
-                std::strcpy(recvMsg, msgBody);
-                // 添加到队列
-                recvMsgQueue.enqueue(recvMsg);
+            // 4、分配内存（与 delete[] 配对，多分配 1 字节存放 '\0'），复制消息体，启用校验时在复制的同时计算校验和
+            const auto recvMsg = new char[msgBodyLength + 1];
+            recvMsg[msgBodyLength] = '\0';
+            if (crc32cEnabled) {
+                uint32_t checksum = crc32c(0, msgHeaderBE, MSG_FRAME_HEADER_SIZE);
+                checksum = crc32cCopy(checksum, recvMsg, msgBody, msgBodyLength);
+                uint32_t expectedChecksum = 0;
+                std::memcpy(&expectedChecksum, msgBody + msgBodyLength, MSG_FRAME_TRAILER_SIZE);
+                if (checksum != ntohl(expectedChecksum)) {
+                    delete[] recvMsg;
+                    resetConnection("Checksum mismatch on stream id: " + std::to_string(streamId));
+                    break;
+                }
             } else {
-                throw std::runtime_error("Malloc memory faild.");
+                std::memcpy(recvMsg, msgBody, msgBodyLength);
+            }
+
+            // 大消息过去一段时间后释放接收缓冲区，每个连接平时只保留较小的缓冲区
+            recvBuffer.shrinkTo(NUMA_BUFFER_RETAIN_CAPACITY, msgBodyLength + trailerLength);
+
+            // 添加到队列
+            if (!recvMsgQueue.enqueue(StreamMsg{streamId, recvMsg})) {
+                delete[] recvMsg;
+                break;
+            }
+        }
+
+        // 接收结束（对端关闭、出错或本端关闭），关闭连接以唤醒消费者
+        closeConnection(false);
+        onWorkerExit();
+    }
+
+    // 将 length 个字节全部写入套接字，失败返回 false
+    bool sendAll(const char* data, const size_t length) const {
+        size_t sent = 0;
+        while (sent < length) {
+            const int result = send(socket, data + sent, static_cast<int>(length - sent), 0);
+            if (result == SOCKET_ERROR) {
+                if (!closed) std::cerr << "Send failed with error: " << WSAGetLastError() << std::endl;
+                return false;
+            }
+            sent += result;
+        }
+        return true;
+    }
+
+    // 从套接字读满 length 个字节，失败或连接关闭返回 false
+    bool recvAll(char* data, const size_t length) const {
+        size_t totalReceived = 0;
+        while (totalReceived < length) {
+            const int bytesReceived = recv(socket, data + totalReceived, static_cast<int>(length - totalReceived), 0);
+            if (bytesReceived == SOCKET_ERROR) {
+                if (!closed) std::cerr << "Recv failed with error: " << WSAGetLastError() << std::endl;
+                return false;
+            }
+            if (bytesReceived == 0) {
+                if (!closed) std::cerr << "Connection closed by the peer." << std::endl;
+                return false;
             }
+            totalReceived += bytesReceived;
+        }
+        return true;
+    }
+
+    // 设置接收超时（毫秒），0 表示不超时
+    bool setRecvTimeout(const DWORD timeoutMs) const {
+        return setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeoutMs),
+                          sizeof(timeoutMs)) != SOCKET_ERROR;
+    }
+
+    // 数据流已经不可信时重置连接：对端收到 RST，本端的生产者和消费者被唤醒
+    void resetConnection(const std::string& reason) {
+        std::cerr << reason << ", resetting connection." << std::endl;
+        closeConnection(true);
+    }
+
+    // 关闭连接和收发队列，只执行一次；套接字由最后退出的收发线程关闭
+    // abortive 为 true 时（只在接收线程中调用）先设置 SO_LINGER{1, 0}，关闭套接字时丢弃未发送的数据并向对端发送 RST；
+    // 两种情况都 shutdown 套接字，唤醒阻塞在 recv 和 send 中的收发线程，不依赖对端继续读取
+    void closeConnection(const bool abortive) {
+        if (closed.exchange(true)) return;
+        if (abortive) {
+            linger lingerOption{};
+            lingerOption.l_onoff = 1;
+            lingerOption.l_linger = 0;
+            setsockopt(socket, SOL_SOCKET, SO_LINGER, reinterpret_cast<const char*>(&lingerOption),
+                       sizeof(lingerOption));
+        }
+        shutdown(socket, SD_BOTH);
+
+        // 关闭队列：发送线程和阻塞在 sendMsg 中的生产者被唤醒，recvMsg 取完剩余消息后返回 nullptr
+        sendMsgQueue.close();
+        recvMsgQueue.close();
+    }
+
+    // 收发线程退出时调用；在两个线程都退出后才关闭套接字，避免另一个线程仍在使用的句柄被关闭后复用
+    void onWorkerExit() {
+        if (--runningWorkers == 0) {
+            closesocket(socket);
         }
     }
 };
@@ -0,0 +1,154 @@
+#ifndef NIO_TCP_RPC_CLIENT_HPP
+#define NIO_TCP_RPC_CLIENT_HPP
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <functional>
+#include <unordered_map>
+
+#include "NioTcpMsgSenderReceiver.hpp"
+
+// 在一条连接上流水线式地发送请求：每个请求分配一个流ID，响应按流ID关联，与响应到达的顺序无关
+// 本对象消费连接收到的所有消息；析构时关闭连接
+class NioTcpRpcClient {
+public:
+    // 响应回调：ok 为 false 表示连接在收到响应前已关闭，此时 response 为空
+    using ResponseCallback = std::function<void(bool ok, const std::string& response)>;
+    // 非响应消息回调：流ID 为 0 的推送消息（例如广播），或没有对应请求的流ID
+    using UnsolicitedMsgCallback = std::function<void(uint32_t streamId, const std::string& msg)>;
+
+    explicit NioTcpRpcClient(NioTcpMsgSenderReceiver& senderReceiver,
+                             UnsolicitedMsgCallback onUnsolicitedMsg = nullptr)
+        : senderReceiver(senderReceiver), onUnsolicitedMsg(std::move(onUnsolicitedMsg)) {
+        // 启动响应分发线程
+        dispatchThreadRunFlag.store(true);
+        dispatchThread = std::thread(&NioTcpRpcClient::dispatchResponseWorker, this);
+    }
+
+    ~NioTcpRpcClient() {
+        // 在析构函数中停止分发线程：关闭连接以唤醒阻塞在 recvMsg 中的分发线程，未完成的请求随后以失败结束
+        dispatchThreadRunFlag.store(false);
+        senderReceiver.close();
+        if (dispatchThread.joinable()) dispatchThread.join();
+    }
+
+    // 发送请求，通过 future 获取响应；连接在收到响应前关闭时 future 抛出 runtime_error
+    std::future<std::string> request(const char* msg) {
+        const auto promise = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> future = promise->get_future();
+        request(msg, [promise](const bool ok, const std::string& response) {
+            if (ok) {
+                promise->set_value(response);
+            } else {
+                promise->set_exception(std::make_exception_ptr(
+                    std::runtime_error("Connection closed before response received.")));
+            }
+        });
+        return future;
+    }
+
+    // 发送请求，响应到达时在分发线程中调用 callback；连接已关闭时在当前线程中以失败调用 callback
+    void request(const char* msg, ResponseCallback callback) {
+        const uint32_t streamId = nextStreamId();
+        {
+            // 先登记再发送，避免响应先于登记到达
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pendingRequests[streamId] = std::move(callback);
+        }
+
+        bool sent = false;
+        try {
+            sent = senderReceiver.sendMsg(msg, streamId);
+        } catch (...) {
+            // 编码失败（例如消息过长），撤销登记
+            takePendingRequest(streamId);
+            throw;
+        }
+        if (!sent) {
+            // 连接已关闭；如果分发线程还没有让这个请求失败，就在这里让它失败
+            ResponseCallback pending = takePendingRequest(streamId);
+            if (pending) pending(false, std::string());
+        }
+    }
+
+    // 尚未收到响应的请求数
+    size_t pendingRequestCount() const {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        return pendingRequests.size();
+    }
+
+private:
+    NioTcpMsgSenderReceiver& senderReceiver;
+    UnsolicitedMsgCallback onUnsolicitedMsg;
+
+    // 下一个可用的流ID（跳过保留的 0）
+    std::atomic<uint32_t> streamIdCounter{MSG_FRAME_DEFAULT_STREAM_ID};
+
+    // 等待响应的请求：流ID -> 回调
+    std::unordered_map<uint32_t, ResponseCallback> pendingRequests;
+    mutable std::mutex pendingMutex;
+
+    // 响应分发线程
+    std::thread dispatchThread;
+    std::atomic<bool> dispatchThreadRunFlag{false};
+
+    uint32_t nextStreamId() {
+        uint32_t streamId = ++streamIdCounter;
+        while (streamId == MSG_FRAME_DEFAULT_STREAM_ID) {
+            streamId = ++streamIdCounter; // 回绕时跳过 0
+        }
+        return streamId;
+    }
+
+    // 取出并移除等待中的请求，不存在时返回空回调
+    ResponseCallback takePendingRequest(const uint32_t streamId) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        const auto it = pendingRequests.find(streamId);
+        if (it == pendingRequests.end()) return nullptr;
+        ResponseCallback callback = std::move(it->second);
+        pendingRequests.erase(it);
+        return callback;
+    }
+
+    // 取出接收消息队列的响应（消费者），按流ID找到对应的请求并完成它
+    void dispatchResponseWorker() {
+        // 与连接的收发线程放在一起
+        senderReceiver.threadPlacement().applyToCurrentThread();
+        while (dispatchThreadRunFlag) {
+            uint32_t streamId = MSG_FRAME_DEFAULT_STREAM_ID;
+            const char* const msg = senderReceiver.recvMsg(streamId);
+            if (!msg) break; // 连接已关闭
+            const std::string response(msg);
+            delete[] msg;
+
+            // 在锁外调用回调，允许回调中继续发起请求
+            ResponseCallback callback = streamId == MSG_FRAME_DEFAULT_STREAM_ID
+                                            ? nullptr
+                                            : takePendingRequest(streamId);
+            if (callback) {
+                callback(true, response);
+            } else if (onUnsolicitedMsg) {
+                onUnsolicitedMsg(streamId, response);
+            } else {
+                std::cerr << "Unexpected message for stream id: " << streamId << std::endl;
+            }
+        }
+
+        // 连接已关闭，让所有未完成的请求失败
+        std::unordered_map<uint32_t, ResponseCallback> failedRequests;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            failedRequests.swap(pendingRequests);
+        }
+        for (auto& failedRequest : failedRequests) {
+            failedRequest.second(false, std::string());
+        }
+    }
+};
+
+#endif // NIO_TCP_RPC_CLIENT_HPP
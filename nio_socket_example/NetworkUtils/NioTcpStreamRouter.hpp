@@ -0,0 +1,120 @@
+#ifndef NIO_TCP_STREAM_ROUTER_HPP
+#define NIO_TCP_STREAM_ROUTER_HPP
+
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+
+#include "NioTcpMsgSenderReceiver.hpp"
+#include "../Utils/ThreadSafeQueue.hpp"
+
+// 服务端按流ID路由请求：同一个流ID的请求总是交给同一个处理线程（保证流内有序），
+// 不同流的请求并发处理，响应带回原来的流ID，因此可以乱序返回
+// 本对象消费连接收到的所有消息；连接关闭后处理完已收到的请求就停止，析构时关闭连接
+class NioTcpStreamRouter {
+public:
+    // 请求处理函数：返回值作为响应发回同一个流；流ID 为 0 的普通消息不回复
+    // 处理函数抛出异常时，回复 "Error: " 加异常信息
+    using RequestHandler = std::function<std::string(uint32_t streamId, const char* msg)>;
+
+    NioTcpStreamRouter(NioTcpMsgSenderReceiver& senderReceiver, RequestHandler handler, const size_t workerCount)
+        : senderReceiver(senderReceiver), handler(std::move(handler)) {
+        if (workerCount == 0) {
+            throw std::invalid_argument("workerCount must be greater than 0");
+        }
+
+        // 启动处理线程，每个处理线程有自己的请求队列
+        for (size_t i = 0; i < workerCount; ++i) {
+            workerQueues.emplace_back(new ThreadSafeQueue<StreamMsg>(MSG_QUEUE_MAXSIZE));
+        }
+        for (size_t i = 0; i < workerCount; ++i) {
+            workerThreads.emplace_back(&NioTcpStreamRouter::handleRequestWorker, this, i);
+        }
+
+        // 启动路由线程
+        routeThreadRunFlag.store(true);
+        routeThread = std::thread(&NioTcpStreamRouter::routeRequestWorker, this);
+    }
+
+    ~NioTcpStreamRouter() {
+        // 在析构函数中停止所有线程：关闭连接以唤醒路由线程，路由线程退出时关闭请求队列以唤醒处理线程
+        routeThreadRunFlag.store(false);
+        senderReceiver.close();
+        if (routeThread.joinable()) routeThread.join();
+        for (auto& workerThread : workerThreads) {
+            if (workerThread.joinable()) workerThread.join();
+        }
+
+        // 在析构函数中释放所有队列元素的内存
+        for (const auto& workerQueue : workerQueues) {
+            StreamMsg item{};
+            while (workerQueue->tryDequeue(item)) {
+                delete[] item.msg;
+            }
+        }
+    }
+
+private:
+    NioTcpMsgSenderReceiver& senderReceiver;
+    RequestHandler handler;
+
+    // 路由线程
+    std::thread routeThread;
+    std::atomic<bool> routeThreadRunFlag{false};
+
+    // 处理线程及其请求队列
+    std::vector<std::thread> workerThreads;
+    std::vector<std::unique_ptr<ThreadSafeQueue<StreamMsg>>> workerQueues;
+
+    // 取出接收消息队列的请求（消费者），按流ID放入对应处理线程的队列（生产者）
+    void routeRequestWorker() {
+        // 与连接的收发线程放在一起
+        senderReceiver.threadPlacement().applyToCurrentThread();
+        while (routeThreadRunFlag) {
+            uint32_t streamId = MSG_FRAME_DEFAULT_STREAM_ID;
+            const char* const msg = senderReceiver.recvMsg(streamId);
+            if (!msg) break; // 连接已关闭
+            workerQueues[streamId % workerQueues.size()]->enqueue(StreamMsg{streamId, msg});
+        }
+
+        // 关闭请求队列：处理线程处理完剩余请求后，取到空请求即退出
+        for (const auto& workerQueue : workerQueues) {
+            workerQueue->close();
+        }
+    }
+
+    // 取出请求队列的请求（消费者），处理后把响应写回同一个流；请求队列关闭并取完后退出
+    void handleRequestWorker(const size_t workerIndex) {
+        ThreadSafeQueue<StreamMsg>& workerQueue = *workerQueues[workerIndex];
+        senderReceiver.threadPlacement().applyToCurrentThread();
+        while (true) {
+            const StreamMsg item = workerQueue.dequeue();
+            if (!item.msg) break; // 请求队列已关闭
+
+            std::string response;
+            try {
+                response = handler(item.streamId, item.msg);
+            } catch (const std::exception& e) {
+                std::cerr << "Request handler failed on stream id: " << item.streamId << ", " << e.what() << std::endl;
+                response = std::string("Error: ") + e.what();
+            } catch (...) {
+                std::cerr << "Request handler failed on stream id: " << item.streamId << std::endl;
+                response = "Error: unknown exception";
+            }
+            delete[] item.msg;
+
+            if (item.streamId == MSG_FRAME_DEFAULT_STREAM_ID) continue;
+            try {
+                senderReceiver.sendMsg(response.c_str(), item.streamId);
+            } catch (const std::length_error& e) {
+                std::cerr << "Response dropped on stream id: " << item.streamId << ", " << e.what() << std::endl;
+            }
+        }
+    }
+};
+
+#endif // NIO_TCP_STREAM_ROUTER_HPP
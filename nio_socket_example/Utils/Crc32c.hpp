@@ -0,0 +1,144 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// x86 上使用 SSE4.2 的 crc32 指令，运行时检测 CPU 是否支持，不支持时使用查表法
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CRC32C_HAS_SSE42_PATH 1
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CRC32C_TARGET_SSE42
+#else
+#include <cpuid.h>
+#define CRC32C_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#endif
+
+// CRC32C（Castagnoli 多项式），用法与 zlib 的 crc32 相同：初始值为 0，可以分段连续计算
+namespace crc32c_detail {
+    // 查表法使用的表（slicing-by-8），第一次使用时生成
+    struct Table {
+        uint32_t t[8][256];
+
+        Table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for (int k = 0; k < 8; ++k) {
+                    crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+                }
+                t[0][i] = crc;
+            }
+            for (uint32_t i = 0; i < 256; ++i) {
+                for (int j = 1; j < 8; ++j) {
+                    t[j][i] = (t[j - 1][i] >> 8) ^ t[0][t[j - 1][i] & 0xFF];
+                }
+            }
+        }
+    };
+
+    inline const Table& table() {
+        static const Table instance;
+        return instance;
+    }
+
+    // 查表法：每次处理8个字节；dst 不为空时同时把数据复制到 dst
+    inline uint32_t updateSoftware(uint32_t state, char* dst, const char* src, size_t length) {
+        const Table& tb = table();
+        const auto* p = reinterpret_cast<const unsigned char*>(src);
+        while (length >= 8) {
+            if (dst) {
+                std::memcpy(dst, p, 8);
+                dst += 8;
+            }
+            const uint32_t lo = state ^ (static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                                         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24);
+            state = tb.t[7][lo & 0xFF] ^ tb.t[6][(lo >> 8) & 0xFF] ^
+                    tb.t[5][(lo >> 16) & 0xFF] ^ tb.t[4][lo >> 24] ^
+                    tb.t[3][p[4]] ^ tb.t[2][p[5]] ^ tb.t[1][p[6]] ^ tb.t[0][p[7]];
+            p += 8;
+            length -= 8;
+        }
+        while (length--) {
+            if (dst) *dst++ = static_cast<char>(*p);
+            state = (state >> 8) ^ tb.t[0][(state ^ *p++) & 0xFF];
+        }
+        return state;
+    }
+
+#ifdef CRC32C_HAS_SSE42_PATH
+    // crc32 指令：每次处理8个字节（32位下为4个字节）；dst 不为空时同时把数据复制到 dst
+    CRC32C_TARGET_SSE42 inline uint32_t updateSse42(uint32_t state, char* dst, const char* src, size_t length) {
+#if defined(__x86_64__) || defined(_M_X64)
+        uint64_t state64 = state;
+        while (length >= 8) {
+            uint64_t word = 0;
+            std::memcpy(&word, src, 8);
+            if (dst) {
+                std::memcpy(dst, &word, 8);
+                dst += 8;
+            }
+            state64 = _mm_crc32_u64(state64, word);
+            src += 8;
+            length -= 8;
+        }
+        state = static_cast<uint32_t>(state64);
+#endif
+        while (length >= 4) {
+            uint32_t word = 0;
+            std::memcpy(&word, src, 4);
+            if (dst) {
+                std::memcpy(dst, &word, 4);
+                dst += 4;
+            }
+            state = _mm_crc32_u32(state, word);
+            src += 4;
+            length -= 4;
+        }
+        while (length--) {
+            if (dst) *dst++ = *src;
+            state = _mm_crc32_u8(state, static_cast<unsigned char>(*src++));
+        }
+        return state;
+    }
+
+    inline bool cpuSupportsSse42() {
+#if defined(_MSC_VER)
+        int info[4]{};
+        __cpuid(info, 1);
+        return (info[2] & (1 << 20)) != 0;
+#else
+        unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+        return (ecx & bit_SSE4_2) != 0;
+#endif
+    }
+#endif
+
+    using UpdateFunc = uint32_t (*)(uint32_t state, char* dst, const char* src, size_t length);
+
+    // 运行时选择实现，只检测一次
+    inline UpdateFunc update() {
+#ifdef CRC32C_HAS_SSE42_PATH
+        static const UpdateFunc func = cpuSupportsSse42() ? &updateSse42 : &updateSoftware;
+#else
+        static const UpdateFunc func = &updateSoftware;
+#endif
+        return func;
+    }
+}
+
+// 计算 data 的 CRC32C，crc 为之前数据的 CRC32C（第一段传 0）
+inline uint32_t crc32c(const uint32_t crc, const char* data, const size_t length) {
+    return ~crc32c_detail::update()(~crc, nullptr, data, length);
+}
+
+// 把 src 复制到 dst，同时计算 src 的 CRC32C，只遍历一次数据
+inline uint32_t crc32cCopy(const uint32_t crc, char* dst, const char* src, const size_t length) {
+    return ~crc32c_detail::update()(~crc, dst, src, length);
+}
+
+#endif // CRC32C_HPP
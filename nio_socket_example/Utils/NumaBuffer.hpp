@@ -0,0 +1,94 @@
+#ifndef NUMA_BUFFER_HPP
+#define NUMA_BUFFER_HPP
+
+#include <stdexcept>
+#include <string>
+#include <winsock2.h>
+#include <windows.h>
+
+#include "ThreadPlacement.hpp"
+
+#define NUMA_BUFFER_MIN_CAPACITY (4 * 1024)
+#define NUMA_BUFFER_RETAIN_CAPACITY (64 * 1024)
+#define NUMA_BUFFER_SHRINK_AFTER_USES 64
+
+// 从指定 NUMA 节点分配内存的可增长缓冲区（按页分配，适合长期复用的缓冲区，不适合小对象）
+// 第一次 reserve 时才分配内存，容量按 2 的幂增长，但不超过 maxCapacity
+class NumaBuffer {
+public:
+    explicit NumaBuffer(const int numaNode, const size_t maxCapacity)
+        : numaNode(numaNode), maxCapacity(maxCapacity) {
+    }
+
+    ~NumaBuffer() {
+        release();
+    }
+
+    NumaBuffer(const NumaBuffer&) = delete;
+    NumaBuffer& operator=(const NumaBuffer&) = delete;
+
+    // 确保容量至少为 size 字节，扩容时不保留原有内容；size 超过 maxCapacity 时抛出 length_error
+    void reserve(const size_t size) {
+        if (size > maxCapacity) {
+            throw std::length_error("NumaBuffer size exceeds max capacity: " + std::to_string(size));
+        }
+        if (buffer && size <= bufferCapacity) return;
+        size_t newCapacity = bufferCapacity ? bufferCapacity : NUMA_BUFFER_MIN_CAPACITY;
+        while (newCapacity < size) newCapacity *= 2;
+        if (newCapacity > maxCapacity) newCapacity = maxCapacity;
+
+        release();
+        void* p = nullptr;
+        if (numaNode == NUMA_NODE_ANY) {
+            p = VirtualAlloc(nullptr, newCapacity, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+            if (!p) {
+                throw std::runtime_error("VirtualAlloc failed: " + std::to_string(GetLastError()));
+            }
+        } else {
+            p = VirtualAllocExNuma(GetCurrentProcess(), nullptr, newCapacity, MEM_RESERVE | MEM_COMMIT,
+                                   PAGE_READWRITE, static_cast<DWORD>(numaNode));
+            if (!p) {
+                throw std::runtime_error("VirtualAllocExNuma failed: " + std::to_string(GetLastError()));
+            }
+        }
+        buffer = static_cast<char*>(p);
+        bufferCapacity = newCapacity;
+    }
+
+    // 每次使用缓冲区后调用，usedSize 为本次使用的字节数；连续 NUMA_BUFFER_SHRINK_AFTER_USES 次使用都不超过
+    // retainCapacity 时才释放超过 retainCapacity 的内存（不保留内容）：偶尔的大消息不会长期占用内存，
+    // 持续的大消息也不会每次都重新分配
+    void shrinkTo(const size_t retainCapacity, const size_t usedSize) {
+        if (bufferCapacity <= retainCapacity || usedSize > retainCapacity) {
+            smallUseCount = 0;
+            return;
+        }
+        if (++smallUseCount >= NUMA_BUFFER_SHRINK_AFTER_USES) {
+            release();
+            smallUseCount = 0;
+        }
+    }
+
+    char* data() const {
+        return buffer;
+    }
+
+    size_t capacity() const {
+        return bufferCapacity;
+    }
+
+private:
+    int numaNode;
+    size_t maxCapacity;
+    char* buffer{nullptr};
+    size_t bufferCapacity{0};
+    size_t smallUseCount{0}; // 连续不超过保留容量的使用次数
+
+    void release() {
+        if (buffer) VirtualFree(buffer, 0, MEM_RELEASE);
+        buffer = nullptr;
+        bufferCapacity = 0;
+    }
+};
+
+#endif // NUMA_BUFFER_HPP
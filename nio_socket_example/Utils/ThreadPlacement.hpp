@@ -0,0 +1,72 @@
+#ifndef THREAD_PLACEMENT_HPP
+#define THREAD_PLACEMENT_HPP
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <winsock2.h>
+#include <windows.h>
+
+#define NUMA_NODE_ANY (-1)
+
+// 线程放置配置：线程绑定到哪个处理器组中的哪些CPU，以及缓冲区从哪个 NUMA 节点分配
+// 默认构造的配置不做任何绑定，线程由操作系统自由调度
+struct ThreadPlacement {
+    WORD group{0};                // 处理器组
+    KAFFINITY cpuMask{0};         // 组内的CPU集合，0 表示不绑定
+    int numaNode{NUMA_NODE_ANY};  // 缓冲区所在的 NUMA 节点，NUMA_NODE_ANY 表示不指定
+
+    // 绑定到指定 NUMA 节点的全部CPU
+    static ThreadPlacement forNumaNode(const USHORT node) {
+        GROUP_AFFINITY groupAffinity{};
+        if (!GetNumaNodeProcessorMaskEx(node, &groupAffinity)) {
+            throw std::runtime_error("GetNumaNodeProcessorMaskEx failed: " + std::to_string(GetLastError()));
+        }
+        ThreadPlacement placement;
+        placement.group = groupAffinity.Group;
+        placement.cpuMask = groupAffinity.Mask;
+        placement.numaNode = node;
+        return placement;
+    }
+
+    // 绑定到指定处理器组中的单个CPU，缓冲区从该CPU所在的 NUMA 节点分配
+    static ThreadPlacement forCpu(const WORD group, const BYTE cpu) {
+        if (cpu >= sizeof(KAFFINITY) * 8) {
+            throw std::invalid_argument("cpu must be less than " + std::to_string(sizeof(KAFFINITY) * 8));
+        }
+        PROCESSOR_NUMBER processor{};
+        processor.Group = group;
+        processor.Number = cpu;
+        USHORT node = 0;
+        if (!GetNumaProcessorNodeEx(&processor, &node)) {
+            throw std::runtime_error("GetNumaProcessorNodeEx failed: " + std::to_string(GetLastError()));
+        }
+        ThreadPlacement placement;
+        placement.group = group;
+        placement.cpuMask = static_cast<KAFFINITY>(1) << cpu;
+        placement.numaNode = node;
+        return placement;
+    }
+
+    // 将当前线程绑定到配置的CPU集合，需要在被绑定的线程内部调用；绑定失败时线程继续自由调度
+    void applyToCurrentThread() const {
+        if (cpuMask == 0) return;
+        GROUP_AFFINITY groupAffinity{};
+        groupAffinity.Group = group;
+        groupAffinity.Mask = cpuMask;
+        if (!SetThreadGroupAffinity(GetCurrentThread(), &groupAffinity, nullptr)) {
+            std::cerr << "SetThreadGroupAffinity failed with error: " << GetLastError() << std::endl;
+        }
+    }
+};
+
+// 系统中 NUMA 节点的个数
+inline unsigned long numaNodeCount() {
+    ULONG highestNodeNumber = 0;
+    if (!GetNumaHighestNodeNumber(&highestNodeNumber)) {
+        return 1;
+    }
+    return highestNodeNumber + 1;
+}
+
+#endif // THREAD_PLACEMENT_HPP
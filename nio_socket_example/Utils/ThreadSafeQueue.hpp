@@ -22,21 +22,44 @@ public:
         maxSize = _maxSize;
     }
 
-    // 向队列中添加元素
-    void enqueue(T value) {
+    // 向队列中添加元素，队列满时阻塞；队列已关闭时返回 false，元素没有入队
+    bool enqueue(T value) {
         std::unique_lock<std::mutex> lock(queueMutex);
-        queueCv.wait(lock, [this] { return queue.size() < maxSize; }); // 队列满时阻塞
+        queueCv.wait(lock, [this] { return queue.size() < maxSize || closed; }); // 队列满时阻塞
+        if (closed) {
+            return false;
+        }
         queue.push(std::move(value));
 
         // 先释放锁，并通知可能在等待的消费者
         lock.unlock();
         queueCv.notify_all();
+
+        return true;
+    }
+
+    // 尝试向队列中添加元素，非阻塞，成功则返回 true，队列满或已关闭则返回 false
+    bool tryEnqueue(T value) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (closed || queue.size() >= maxSize) {
+            return false;
+        }
+        queue.push(std::move(value));
+
+        // 先释放锁，然后通知可能在等待的消费者
+        lock.unlock();
+        queueCv.notify_all();
+
+        return true;
     }
 
-    // 从队列中取出元素，如果队列为空，则阻塞线程，直到队列不为空
+    // 从队列中取出元素，如果队列为空，则阻塞线程，直到队列不为空；队列已关闭且为空时返回 T()
     T dequeue() {
         std::unique_lock<std::mutex> lock(queueMutex);
-        queueCv.wait(lock, [this] { return !queue.empty(); }); // 等待队列非空
+        queueCv.wait(lock, [this] { return !queue.empty() || closed; }); // 等待队列非空
+        if (queue.empty()) {
+            return T();
+        }
         T value = std::move(queue.front());
         queue.pop();
 
@@ -63,6 +86,21 @@ public:
         return true;
     }
 
+    // 关闭队列，唤醒所有阻塞的生产者和消费者；之后不能再添加元素，剩余元素仍可取出
+    void close() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        closed = true;
+
+        lock.unlock();
+        queueCv.notify_all();
+    }
+
+    // 队列是否已关闭
+    bool isClosed() const {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        return closed;
+    }
+
     // 检查队列是否为空
     bool empty() const {
         std::unique_lock<std::mutex> lock(queueMutex);
@@ -78,6 +116,7 @@ public:
 private:
     size_t maxSize{QUEUE_DEFAULT_MAXSIZE}; // 最大队列大小
     std::queue<T> queue;
+    bool closed{false}; // 队列是否已关闭
     mutable std::mutex queueMutex;
     std::condition_variable queueCv;
 };
@@ -54,13 +54,14 @@ void tcpClientWorker(const char* server_ip, const unsigned short server_port) {
     // 连接到服务器
     const SOCKET clientSocket = connectToServer(server_ip, server_port);
 
-    // 创建 NIO 对象
-    NioTcpMsgSenderReceiver nioTcpMsgSenderReceiver(clientSocket);
+    // 创建 NIO 对象，服务端也支持时启用 CRC32C 校验
+    NioTcpMsgSenderReceiver nioTcpMsgSenderReceiver(clientSocket, ThreadPlacement(), MSG_FRAME_FEATURE_CRC32C);
 
     // 接收数据线程，模拟处理数据较慢的情况
     std::thread processMsgThread([&nioTcpMsgSenderReceiver] {
         while (true) {
             const char* newMsg = nioTcpMsgSenderReceiver.recvMsg();
+            if (!newMsg) break; // 连接已关闭
             std::cout << "[received] " << newMsg << " recvMsgQueue size: " << nioTcpMsgSenderReceiver.recvMsgQueueSize() << std::endl;
             delete[] newMsg;
             // 随机数生成器
@@ -78,7 +79,7 @@ void tcpClientWorker(const char* server_ip, const unsigned short server_port) {
 
     // 发送数据线程，模拟发送数据较快的情况
     std::thread sendMsgThread1([&nioTcpMsgSenderReceiver] {
-        while (true) {
+        while (!nioTcpMsgSenderReceiver.isClosed()) {
             for (auto i = 0; i < 3; ++i) {
                 std::ostringstream oss;
                 oss << "Send from thread id: " << std::this_thread::get_id() << ", msg: " << "hello world!" << " EOF";
@@ -98,7 +99,7 @@ void tcpClientWorker(const char* server_ip, const unsigned short server_port) {
     });
 
     std::thread sendMsgThread2([&nioTcpMsgSenderReceiver] {
-        while (true) {
+        while (!nioTcpMsgSenderReceiver.isClosed()) {
             for (auto i = 0; i < 3; ++i) {
                 std::ostringstream oss;
                 oss << "Send from thread id: " << std::this_thread::get_id() << ", msg: " << "hello world!" << " EOF";
@@ -4,20 +4,43 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <random>
+#include <memory>
+#include <vector>
 
 #include "NetworkUtils/NioTcpMsgSenderReceiver.hpp"
+#include "NetworkUtils/NioTcpMsgBroadcaster.hpp"
+#include "Utils/ThreadPlacement.hpp"
 
 #pragma comment(lib, "ws2_32.lib")
 
-// 处理客户端线程
-void handleClientWorker(const SOCKET clientSocket) {
-    // 创建 NIO 对象
-    NioTcpMsgSenderReceiver nioTcpMsgSenderReceiver(clientSocket);
+// 向所有客户端广播消息
+NioTcpMsgBroadcaster broadcaster;
+
+// 处理客户端线程，placement 指定该连接所有线程的放置位置
+void handleClientWorker(const SOCKET clientSocket, const ThreadPlacement placement) {
+    placement.applyToCurrentThread();
+
+    // 创建 NIO 对象，收发线程与本线程放在同一组CPU上，客户端也支持时启用 CRC32C 校验
+    // 握手失败（例如端口扫描、健康检查或旧版本客户端）只关闭这个连接，不影响服务端
+    std::unique_ptr<NioTcpMsgSenderReceiver> nio;
+    try {
+        nio.reset(new NioTcpMsgSenderReceiver(clientSocket, placement, MSG_FRAME_FEATURE_CRC32C));
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        closesocket(clientSocket);
+        return;
+    }
+    NioTcpMsgSenderReceiver& nioTcpMsgSenderReceiver = *nio;
+
+    // 订阅广播消息，发送队列满时跳过广播消息
+    broadcaster.subscribe("broadcast", &nioTcpMsgSenderReceiver, SlowSubscriberPolicy::DropMsg);
 
     // 接收数据线程，模拟处理数据较慢的情况
     std::thread processMsgThread([&nioTcpMsgSenderReceiver] {
+        nioTcpMsgSenderReceiver.threadPlacement().applyToCurrentThread();
         while (true) {
             const char* newMsg = nioTcpMsgSenderReceiver.recvMsg();
+            if (!newMsg) break; // 连接已关闭
             std::cout << "[received] " << newMsg << " recvMsgQueue size: " << nioTcpMsgSenderReceiver.recvMsgQueueSize() << std::endl;
             delete[] newMsg;
             // 随机数生成器
@@ -35,7 +58,8 @@ void handleClientWorker(const SOCKET clientSocket) {
 
     // 发送数据线程，模拟发送数据较快的情况
     std::thread sendMsgThread1([&nioTcpMsgSenderReceiver] {
-        while (true) {
+        nioTcpMsgSenderReceiver.threadPlacement().applyToCurrentThread();
+        while (!nioTcpMsgSenderReceiver.isClosed()) {
             for (auto i = 0; i < 3; ++i) {
                 std::ostringstream oss;
                 oss << "Send from thread id: " << std::this_thread::get_id() << ", msg: " << "hello world!" << " EOF";
@@ -55,7 +79,8 @@ void handleClientWorker(const SOCKET clientSocket) {
     });
 
     std::thread sendMsgThread2([&nioTcpMsgSenderReceiver] {
-        while (true) {
+        nioTcpMsgSenderReceiver.threadPlacement().applyToCurrentThread();
+        while (!nioTcpMsgSenderReceiver.isClosed()) {
             for (auto i = 0; i < 3; ++i) {
                 std::ostringstream oss;
                 oss << "Send from thread id: " << std::this_thread::get_id() << ", msg: " << "hello world!" << " EOF";
@@ -78,6 +103,20 @@ void handleClientWorker(const SOCKET clientSocket) {
     if (processMsgThread.joinable()) processMsgThread.join();
     if (sendMsgThread1.joinable()) sendMsgThread1.join();
     if (sendMsgThread2.joinable()) sendMsgThread2.join();
+
+    // 销毁 NIO 对象前取消订阅
+    broadcaster.unsubscribeAll(&nioTcpMsgSenderReceiver);
+}
+
+// 广播线程，定时向所有客户端推送同一条消息
+void broadcastWorker() {
+    while (true) {
+        std::ostringstream oss;
+        oss << "Broadcast from server, msg: " << "hello everyone!" << " EOF";
+        const size_t delivered = broadcaster.publish("broadcast", oss.str().c_str());
+        std::cout << "[broadcast] delivered to " << delivered << " clients" << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+    }
 }
 
 // 监听线程
@@ -125,6 +164,21 @@ void tcpServerListenWorker(const char* server_ip, const unsigned short server_po
 
     std::cout << "Server listening on port " << server_port << "..." << std::endl;
 
+    // 按 NUMA 节点轮流放置新连接；获取失败的节点跳过，都失败时不做绑定
+    std::vector<ThreadPlacement> placements;
+    const unsigned long nodeCount = numaNodeCount();
+    if (nodeCount > 1) {
+        for (unsigned long node = 0; node < nodeCount; ++node) {
+            try {
+                placements.push_back(ThreadPlacement::forNumaNode(static_cast<USHORT>(node)));
+            } catch (const std::exception& e) {
+                std::cerr << "Skipping NUMA node " << node << ": " << e.what() << std::endl;
+            }
+        }
+    }
+    if (placements.empty()) placements.emplace_back();
+    size_t connectionCount = 0;
+
     while (true) {
         auto newSocket = INVALID_SOCKET;
         int addrlen = sizeof(address);
@@ -138,7 +192,8 @@ void tcpServerListenWorker(const char* server_ip, const unsigned short server_po
         std::cout << "New connection accepted." << std::endl;
 
         // 创建线程处理新的客户端连接
-        std::thread(handleClientWorker, newSocket).detach();
+        const ThreadPlacement& placement = placements[connectionCount++ % placements.size()];
+        std::thread(handleClientWorker, newSocket, placement).detach();
     }
 }
 
@@ -146,5 +201,7 @@ int main() {
     auto server_ip = "127.0.0.1";
     unsigned short server_port = 9900;
     std::thread tcpServerListenThread(tcpServerListenWorker, server_ip, server_port);
+    std::thread broadcastThread(broadcastWorker);
     tcpServerListenThread.join();
+    broadcastThread.join();
 }